@@ -27,10 +27,10 @@ ValuePtr len(const std::vector<ValuePtr>& args) {
         throw std::runtime_error("len() takes one argument");
     }
     if (auto str = std::dynamic_pointer_cast<StringValue>(args[0])) {
-        return std::make_shared<IntValue>(std::to_string(str->value.size()));
+        return std::make_shared<IntValue>(static_cast<long long>(str->value.size()));
     }
     if (auto list = std::dynamic_pointer_cast<ListValue>(args[0])) {
-        return std::make_shared<IntValue>(std::to_string(list->elements.size()));
+        return std::make_shared<IntValue>(static_cast<long long>(list->elements.size()));
     }
     throw std::runtime_error("len() argument must be string or list");
 }
@@ -72,11 +72,11 @@ ValuePtr range(const std::vector<ValuePtr>& args) {
     std::vector<ValuePtr> elems;
     if (step > 0) {
         for (RealNumber i = start; i < end; i += step) {
-            elems.push_back(std::make_shared<IntValue>(i.convert_to<std::string>()));
+            elems.push_back(std::make_shared<IntValue>(i));
         }
     } else {
         for (RealNumber i = start; i > end; i += step) {
-            elems.push_back(std::make_shared<IntValue>(i.convert_to<std::string>()));
+            elems.push_back(std::make_shared<IntValue>(i));
         }
     }
 
@@ -1,67 +1,89 @@
 #include "real_number.hpp"
 
-RealNumber::RealNumber(long long x) {
-    if (x < 0) {
-        negative_ = true;
-        x = -x;
-    } else {
-        negative_ = false;
+#include <algorithm>
+#include <bit>
+#include <deque>
+#include <limits>
+#include <numeric>
+
+RealNumber::ReduceBudget RealNumber::reduce_budget_;
+size_t RealNumber::precision_ = 10;
+
+RealNumber::RealNumber(long long x) : negative_(false), is_small_(true), small_(x) {
+    if (!FitsInline(x)) {
+        Promote();
     }
-    num_ = std::to_string(x);
-    den_ = "1";
 }
 
-RealNumber::RealNumber(const std::string &s) {
+RealNumber::RealNumber(const std::string &s) : negative_(false), is_small_(false), small_(0) {
     std::string str = s;
-    negative_ = false;
     if (!str.empty() && str[0] == '-') {
         negative_ = true;
         str.erase(str.begin());
     }
     size_t epos = str.find_first_of("eE");
-    int expo = 0;
+    long long expo = 0;
     if (epos != std::string::npos) {
         expo = std::stoi(str.substr(epos + 1));
         str = str.substr(0, epos);
     }
+    std::string digits = str;
     size_t dot = str.find('.');
-    if (dot == std::string::npos) {
-        num_ = Normalize(str);
-        den_ = "1";
-    } else {
-        std::string intpart = str.substr(0, dot);
-        std::string frac = str.substr(dot + 1);
-        num_ = Normalize(intpart + frac);
-        den_ = "1" + std::string(frac.size(), '0');
+    if (dot != std::string::npos) {
+        digits = str.substr(0, dot) + str.substr(dot + 1);
+        expo -= static_cast<long long>(str.size() - dot - 1);
+    }
+    for (char c : digits) {
+        if (c < '0' || c > '9') {
+            throw std::invalid_argument("invalid number: " + s);
+        }
+    }
+    if (expo == 0 && digits.size() <= 18) {
+        long long value = 0;
+        for (char c : digits) value = value * 10 + (c - '0');
+        *this = RealNumber(negative_ ? -value : value);
+        return;
     }
-    if (num_.empty()) num_ = "0";
+    num_ = ParseDecimal(digits);
     if (expo > 0) {
-        num_ += std::string(expo, '0');
-    } else if (expo < 0) {
-        den_ += std::string(-expo, '0');
+        num_ = MulBig(num_, Pow10(static_cast<size_t>(expo)));
     }
-    if (den_.empty()) den_ = "1";
-    num_ = Normalize(num_);
-    den_ = Normalize(den_);
+    den_ = expo < 0 ? Pow10(static_cast<size_t>(-expo)) : Limbs{1};
+    Reduce();
+}
+
+RealNumber::RealNumber(Limbs num, Limbs den, bool negative)
+    : num_(std::move(num)), den_(std::move(den)), negative_(negative),
+      is_small_(false), small_(0) {
+    Normalize(num_);
+    Normalize(den_);
     Reduce();
 }
 
 RealNumber& RealNumber::operator+=(const RealNumber &o) {
-    std::string a = num_, b = den_, c = o.num_, d = o.den_;
-    bool sa = negative_, sb = o.negative_;
-    std::string ad = MulBig(a, d);
-    std::string bc = MulBig(c, b);
+    if (is_small_ && o.is_small_) {
+        long long res;
+        if (!__builtin_add_overflow(small_, o.small_, &res) && FitsInline(res)) {
+            small_ = res;
+            return *this;
+        }
+    }
+    Promote();
+    RealNumber tmp;
+    const RealNumber &rhs = BigView(o, tmp);
+    Limbs ad = MulBig(num_, rhs.den_);
+    Limbs bc = MulBig(rhs.num_, den_);
+    bool sa = negative_, sb = rhs.negative_;
     if (sa == sb) {
         num_ = AddBig(ad, bc);
         negative_ = sa;
     } else {
-        if (ad == bc) {
-            num_ = "0";
-            negative_ = false;
-            den_ = "1";
+        int cmp = CompareBig(ad, bc);
+        if (cmp == 0) {
+            *this = RealNumber();
             return *this;
         }
-        if (LessThanBig(bc, ad)) {
+        if (cmp > 0) {
             num_ = SubBig(ad, bc);
             negative_ = sa;
         } else {
@@ -69,35 +91,48 @@ RealNumber& RealNumber::operator+=(const RealNumber &o) {
             negative_ = sb;
         }
     }
-    den_ = MulBig(b, d);
-    num_ = Normalize(num_);
-    den_ = Normalize(den_);
-    Reduce();
+    den_ = MulBig(den_, rhs.den_);
+    ReduceLazily();
     return *this;
 }
 
 RealNumber& RealNumber::operator-=(const RealNumber &o) {
-    RealNumber tmp = o;
-    tmp.negative_ = !o.negative_;
-    return *this += tmp;
+    return *this += -o;
 }
 
 RealNumber& RealNumber::operator*=(const RealNumber &o) {
-    num_ = MulBig(num_, o.num_);
-    den_ = MulBig(den_, o.den_);
-    negative_ = (negative_ != o.negative_);
-    num_ = Normalize(num_);
-    den_ = Normalize(den_);
-    Reduce();
+    if (is_small_ && o.is_small_) {
+        long long res;
+        if (!__builtin_mul_overflow(small_, o.small_, &res) && FitsInline(res)) {
+            small_ = res;
+            return *this;
+        }
+    }
+    Promote();
+    RealNumber tmp;
+    const RealNumber &rhs = BigView(o, tmp);
+    num_ = MulBig(num_, rhs.num_);
+    den_ = MulBig(den_, rhs.den_);
+    negative_ = (negative_ != rhs.negative_);
+    ReduceLazily();
     return *this;
 }
 
 RealNumber& RealNumber::operator/=(const RealNumber &o) {
-    if (o.num_ == "0") throw std::runtime_error("division by zero");
-    RealNumber inv = o;
-    std::swap(inv.num_, inv.den_);
-    *this *= inv;
-    negative_ = (negative_ != o.negative_);
+    if (o.IsZero()) throw std::runtime_error("division by zero");
+    if (is_small_ && o.is_small_ && small_ % o.small_ == 0) {
+        small_ /= o.small_;
+        return *this;
+    }
+    Promote();
+    RealNumber tmp;
+    const RealNumber &rhs = BigView(o, tmp);
+    Limbs num = MulBig(num_, rhs.den_);
+    Limbs den = MulBig(den_, rhs.num_);
+    num_ = std::move(num);
+    den_ = std::move(den);
+    negative_ = (negative_ != rhs.negative_);
+    ReduceLazily();
     return *this;
 }
 
@@ -107,14 +142,12 @@ RealNumber& RealNumber::operator%=(const RealNumber &o) {
 }
 
 RealNumber& RealNumber::operator^=(const RealNumber &o) {
-    if (o.den_ == "1") {
-        long long exp = 0;
-        if (o.num_.size() <= 18) {
-            exp = std::stoll(o.num_);
-            if (o.negative_) exp = -exp;
-        } else {
+    o.Canonicalize();
+    if (o.is_small_ || IsOne(o.den_)) {
+        if (!o.is_small_) {
             throw std::runtime_error("exponent too large");
         }
+        long long exp = o.small_;
         if (exp == 0) {
             *this = RealNumber(1);
             return *this;
@@ -129,39 +162,71 @@ RealNumber& RealNumber::operator^=(const RealNumber &o) {
             if (exp & 1) {
                 *this = *this * base;
             }
-            base = base * base;
             exp >>= 1;
+            if (exp > 0) {
+                base = base * base;
+            }
         }
         return *this;
-    } else {
-        long double x = std::stold(this->convert_to<std::string>());
-        long double y = std::stold(o.convert_to<std::string>());
-        long double p = powl(x, y);
-        if (std::isnan(p) || std::isinf(p)) {
-            throw std::runtime_error("invalid power operation");
-        }
-        std::ostringstream oss;
-        oss << std::fixed << std::setprecision(10) << p;
-        std::string s = oss.str();
-        while (!s.empty() && s.back() == '0') {
-            s.pop_back();
-        }
-        if (!s.empty() && s.back() == '.') {
-            s.pop_back();
-        }
-        *this = RealNumber(s);
+    }
+    // Non-integer exponent a/b: |x|^(a/b) = exp(a/b * ln|x|), evaluated in
+    // binary fixed point wide enough for the magnitude of the result plus
+    // precision_ decimal places. A negative base has a real root only for
+    // odd b.
+    RealNumber ytmp;
+    const RealNumber &y = BigView(o, ytmp);
+    if (IsZero()) {
+        if (y.negative_) throw std::runtime_error("invalid power operation");
+        return *this;
+    }
+    RealNumber xtmp;
+    const RealNumber &x = BigView(*this, xtmp);
+    bool negate = false;
+    if (x.negative_) {
+        if ((y.den_[0] & 1) == 0) throw std::runtime_error("invalid power operation");
+        negate = (y.num_[0] & 1) != 0;
+    }
+    long long xbits = static_cast<long long>(BitLength(x.num_)) - static_cast<long long>(BitLength(x.den_));
+    long long ybits = static_cast<long long>(BitLength(y.num_)) - static_cast<long long>(BitLength(y.den_)) + 1;
+    long double estimate = std::ldexp(static_cast<long double>(std::llabs(xbits) + 1), static_cast<int>(ybits));
+    bool grows = (xbits > 0 || (xbits == 0 && !LessThanBig(x.num_, x.den_))) != y.negative_;
+    if (grows && estimate > kMaxPowerBits) throw std::runtime_error("invalid power operation");
+    if (!grows && estimate > kMaxPowerBits) {
+        *this = RealNumber();
         return *this;
     }
+    size_t bits = (grows ? static_cast<size_t>(estimate) : 0) + precision_ * 10 / 3 + 64;
+    size_t lnBits = bits + static_cast<size_t>(std::max(ybits, 0LL)) + 16;
+    SignedLimbs t = LnFixed(x.num_, x.den_, lnBits);
+    Limbs scaled, unused;
+    DivmodBig(MulBig(t.mag, y.num_), y.den_, scaled, unused);
+    t.mag = ShiftRight(scaled, lnBits - bits);
+    t.negative = !t.mag.empty() && (t.negative != y.negative_);
+    long long exponent = 0;
+    Limbs e = MulBig(ExpFixed(t, bits, exponent), Pow10(precision_));
+    long long shift = exponent - static_cast<long long>(bits);
+    if (shift >= 0) {
+        e = ShiftLeft(e, static_cast<size_t>(shift));
+    } else {
+        e = AddBig(e, ShiftLeft({1}, static_cast<size_t>(-shift - 1)));
+        e = ShiftRight(e, static_cast<size_t>(-shift));
+    }
+    *this = RealNumber(std::move(e), Pow10(precision_), negate);
+    return *this;
 }
 
 RealNumber RealNumber::operator-() const {
     RealNumber result = *this;
-    result.negative_ = !result.negative_;
+    if (result.is_small_) {
+        result.small_ = -result.small_;
+    } else {
+        result.negative_ = !result.negative_;
+    }
     return result;
 }
 
 RealNumber& RealNumber::operator++() {
-    *this = *this + RealNumber("1");
+    *this += RealNumber(1);
     return *this;
 }
 
@@ -172,7 +237,7 @@ RealNumber RealNumber::operator++(int) {
 }
 
 RealNumber& RealNumber::operator--() {
-    *this = *this - RealNumber("1");
+    *this -= RealNumber(1);
     return *this;
 }
 
@@ -183,6 +248,11 @@ RealNumber RealNumber::operator--(int) {
 }
 
 bool RealNumber::operator==(const RealNumber &o) const {
+    Canonicalize();
+    o.Canonicalize();
+    if (is_small_ || o.is_small_) {
+        return is_small_ == o.is_small_ && small_ == o.small_;
+    }
     return negative_ == o.negative_ && num_ == o.num_ && den_ == o.den_;
 }
 
@@ -191,10 +261,14 @@ bool RealNumber::operator!=(const RealNumber &o) const {
 }
 
 bool RealNumber::operator<(const RealNumber &o) const {
-    if (negative_ != o.negative_) return negative_;
-    std::string ad = MulBig(num_, o.den_);
-    std::string bc = MulBig(o.num_, den_);
-    if (negative_) {
+    if (is_small_ && o.is_small_) return small_ < o.small_;
+    RealNumber ltmp, rtmp;
+    const RealNumber &lhs = BigView(*this, ltmp);
+    const RealNumber &rhs = BigView(o, rtmp);
+    if (lhs.negative_ != rhs.negative_) return lhs.negative_;
+    Limbs ad = MulBig(lhs.num_, rhs.den_);
+    Limbs bc = MulBig(rhs.num_, lhs.den_);
+    if (lhs.negative_) {
         return LessThanBig(bc, ad);
     } else {
         return LessThanBig(ad, bc);
@@ -238,16 +312,19 @@ RealNumber operator/(RealNumber a, const RealNumber &b) {
 }
 
 RealNumber operator%(const RealNumber &a, const RealNumber &b) {
-    if (b.num_ == "0") throw std::runtime_error("division by zero");
-    std::string A = RealNumber::MulBig(a.num_, b.den_);
-    std::string B = RealNumber::MulBig(b.num_, a.den_);
-    std::string qStr, rStr;
-    RealNumber::DivmodBig(A, B, qStr, rStr);
-    if (qStr.empty()) qStr = "0";
-    RealNumber q(qStr);
-    q.negative_ = (a.negative_ != b.negative_) && (qStr != "0");
+    if (b.IsZero()) throw std::runtime_error("division by zero");
+    if (a.is_small_ && b.is_small_) {
+        return RealNumber(a.small_ % b.small_);
+    }
+    RealNumber atmp, btmp;
+    const RealNumber &lhs = RealNumber::BigView(a, atmp);
+    const RealNumber &rhs = RealNumber::BigView(b, btmp);
+    RealNumber::Limbs A = RealNumber::MulBig(lhs.num_, rhs.den_);
+    RealNumber::Limbs B = RealNumber::MulBig(rhs.num_, lhs.den_);
+    RealNumber::Limbs qLimbs, rLimbs;
+    RealNumber::DivmodBig(A, B, qLimbs, rLimbs);
+    RealNumber q(std::move(qLimbs), {1}, lhs.negative_ != rhs.negative_);
     RealNumber res = a - b * q;
-    res.Reduce();
     return res;
 }
 
@@ -258,52 +335,47 @@ RealNumber operator^(RealNumber base, const RealNumber &exponent) {
 
 RealNumber RealNumber::abs() const {
     RealNumber result = *this;
-    result.negative_ = false;
+    if (result.is_small_) {
+        result.small_ = result.small_ < 0 ? -result.small_ : result.small_;
+    } else {
+        result.negative_ = false;
+    }
     return result;
 }
 
 RealNumber RealNumber::ceil() const {
-    RealNumber negated = *this;
-    negated.negative_ = !negative_;
-    return -(negated.floor());
+    return -((-*this).floor());
 }
 
 RealNumber RealNumber::floor() const {
-    std::string q, r;
+    if (is_small_) return *this;
+    Limbs q, r;
     DivmodBig(num_, den_, q, r);
-    if (!negative_) {
-        return RealNumber(q);
-    } else {
-        if (r == "0") {
-            RealNumber res(q);
-            res.negative_ = true;
-            return res;
-        } else {
-            RealNumber qPlusOne = RealNumber(q) + RealNumber(1);
-            qPlusOne.negative_ = true;
-            return qPlusOne;
-        }
+    if (negative_ && !r.empty()) {
+        q = AddBig(q, {1});
     }
+    return RealNumber(std::move(q), {1}, negative_);
 }
 
 RealNumber RealNumber::round() const {
+    if (is_small_) return *this;
     RealNumber absVal = this->abs();
-    absVal += RealNumber("0.5");
+    absVal += RealNumber(Limbs{1}, Limbs{2}, false);
     RealNumber floored = absVal.floor();
-    if (negative_) floored.negative_ = true;
-    return floored;
+    return negative_ ? -floored : floored;
 }
 
+// floor(sqrt(x) * 10^(p+1)) is exact from an integer square root, and rounding
+// its last digit gives sqrt(x) correctly rounded to p places.
 RealNumber RealNumber::sqrt() const {
-    if (negative_) throw std::runtime_error("sqrt of negative number");
-    long double x = std::stold(this->convert_to<std::string>());
-    long double s = std::sqrt(x);
-    std::ostringstream oss;
-    oss << std::fixed << std::setprecision(10) << s;
-    std::string s_str = oss.str();
-    while (!s_str.empty() && s_str.back() == '0') s_str.pop_back();
-    if (!s_str.empty() && s_str.back() == '.') s_str.pop_back();
-    return RealNumber(s_str);
+    if (*this < RealNumber(0)) throw std::runtime_error("sqrt of negative number");
+    RealNumber tmp;
+    const RealNumber &x = BigView(*this, tmp);
+    Limbs scaled, unused;
+    DivmodBig(MulBig(x.num_, Pow10(2 * precision_ + 2)), x.den_, scaled, unused);
+    Limbs root = AddBig(Isqrt(scaled), {5});
+    DivmodSmall(root, 10);
+    return RealNumber(std::move(root), Pow10(precision_), false);
 }
 
 RealNumber::operator long long() const {
@@ -318,112 +390,948 @@ std::ostream& operator<<(std::ostream& os, const RealNumber& v) {
     return os << v.toString();
 }
 
-std::string RealNumber::Normalize(const std::string &s) {
-    size_t p = 0;
-    while (p < s.size() && s[p] == '0') p++;
-    if (p == s.size()) return "0";
-    return s.substr(p);
-}
-
-bool RealNumber::LessThanBig(const std::string &a, const std::string &b) {
-    if (a.size() != b.size())
-        return a.size() < b.size();
-    return a < b;
-}
-
-std::string RealNumber::AddBig(const std::string &a, const std::string &b) {
-    std::string A = a, B = b;
-    if (A.size() < B.size()) A.insert(A.begin(), B.size() - A.size(), '0');
-    if (B.size() < A.size()) B.insert(B.begin(), A.size() - B.size(), '0');
-    int carry = 0;
-    std::string C(A.size(), '0');
-    for (int i = A.size() - 1; i >= 0; --i) {
-        int sum = (A[i] - '0') + (B[i] - '0') + carry;
-        carry = sum / 10;
-        C[i] = char('0' + (sum % 10));
-    }
-    if (carry) C.insert(C.begin(), char('0' + carry));
-    return Normalize(C);
-}
-
-std::string RealNumber::SubBig(const std::string &a, const std::string &b) {
-    std::string A = a, B = b;
-    B.insert(B.begin(), A.size() - B.size(), '0');
-    int borrow = 0;
-    std::string C(A.size(), '0');
-    for (int i = A.size() - 1; i >= 0; --i) {
-        int diff = (A[i] - '0') - (B[i] - '0') - borrow;
-        if (diff < 0) {
-            diff += 10;
-            borrow = 1;
-        } else {
-            borrow = 0;
+// The fractional part of r / den (in lowest terms) has a preperiod equal to
+// the larger power of 2 or 5 in den, and a period equal to the
+// multiplicative order of 10 modulo what remains. Knowing both lengths up
+// front, every digit that is printed comes out of a single division
+// floor(r * 10^k / den). Periods are only shown when the whole expansion fits
+// in kMaxFractionDigits; longer ones are truncated to that many digits.
+std::string RealNumber::ToDecimalString() const {
+    Canonicalize();
+    if (is_small_) return std::to_string(small_);
+    std::string s;
+    if (negative_ && !num_.empty()) s.push_back('-');
+    Limbs q, r;
+    DivmodBig(num_, den_, q, r);
+    s += FormatDecimal(q);
+    if (r.empty()) return s;
+
+    size_t twos = 0;
+    while (den_[twos / kLimbBits] == 0) twos += kLimbBits;
+    twos += std::countr_zero(den_[twos / kLimbBits]);
+    Limbs rest = ShiftRight(den_, twos);
+    size_t fives = 0;
+    for (Limb step : {Limb(1220703125), Limb(5)}) {
+        size_t power = step == 5 ? 1 : 13;
+        while (true) {
+            Limbs tmp = rest;
+            if (DivmodSmall(tmp, step) != 0) break;
+            rest = std::move(tmp);
+            fives += power;
+        }
+    }
+    size_t preperiod = std::max(twos, fives);
+
+    size_t period = 0;
+    if (!IsOne(rest) && preperiod < kMaxFractionDigits && rest.size() <= 2) {
+        unsigned long long mod = rest[0];
+        if (rest.size() == 2) mod |= static_cast<unsigned long long>(rest[1]) << kLimbBits;
+        unsigned long long power = 1;
+        for (size_t len = 1; len + preperiod <= kMaxFractionDigits; ++len) {
+            power = static_cast<unsigned long long>(
+                static_cast<unsigned __int128>(power) * 10 % mod);
+            if (power == 1) {
+                period = len;
+                break;
+            }
         }
-        C[i] = char('0' + diff);
     }
-    return Normalize(C);
+
+    size_t count = IsOne(rest) ? preperiod
+                 : period != 0 ? preperiod + period
+                               : kMaxFractionDigits;
+    Limbs block, unused;
+    DivmodBig(MulBig(r, Pow10(count)), den_, block, unused);
+    std::string digits;
+    FormatDecimalInto(block, digits, count);
+
+    s.push_back('.');
+    if (period == 0) {
+        s += digits;
+    } else {
+        s.append(digits, 0, preperiod);
+        s.push_back('(');
+        s.append(digits, preperiod, period);
+        s.push_back(')');
+    }
+    return s;
+}
+
+long long RealNumber::ToInteger() const {
+    Canonicalize();
+    if (is_small_) return small_;
+    Limbs q, r;
+    DivmodBig(num_, den_, q, r);
+    if (q.size() > 2 ||
+        CompareBig(q, FromUnsigned(std::numeric_limits<long long>::max())) > 0) {
+        throw std::out_of_range("integer value out of range");
+    }
+    unsigned long long magnitude = 0;
+    for (size_t i = q.size(); i-- > 0;) {
+        magnitude = (magnitude << kLimbBits) | q[i];
+    }
+    long long val = static_cast<long long>(magnitude);
+    return negative_ ? -val : val;
+}
+
+bool RealNumber::FitsInline(long long v) {
+    return v != std::numeric_limits<long long>::min();
+}
+
+// Returns `o` itself, or a limb-backed copy of it stored in `tmp` when `o`
+// is an inline integer.
+const RealNumber& RealNumber::BigView(const RealNumber &o, RealNumber &tmp) {
+    if (!o.is_small_) return o;
+    tmp = o;
+    tmp.Promote();
+    return tmp;
+}
+
+bool RealNumber::IsZero() const {
+    return is_small_ ? small_ == 0 : num_.empty();
+}
+
+void RealNumber::Promote() {
+    if (!is_small_) return;
+    unsigned long long magnitude = static_cast<unsigned long long>(small_);
+    negative_ = small_ < 0;
+    if (negative_) magnitude = 0ULL - magnitude;
+    num_ = FromUnsigned(magnitude);
+    den_ = {1};
+    is_small_ = false;
+    small_ = 0;
+}
+
+void RealNumber::TryInline() const {
+    if (is_small_ || !IsOne(den_) || num_.size() > 2) return;
+    unsigned long long magnitude = 0;
+    for (size_t i = num_.size(); i-- > 0;) {
+        magnitude = (magnitude << kLimbBits) | num_[i];
+    }
+    if (magnitude > static_cast<unsigned long long>(std::numeric_limits<long long>::max())) return;
+    small_ = negative_ ? -static_cast<long long>(magnitude) : static_cast<long long>(magnitude);
+    is_small_ = true;
+    negative_ = false;
+    num_.clear();
+    den_.clear();
+}
+
+void RealNumber::Normalize(Limbs &a) {
+    while (!a.empty() && a.back() == 0) a.pop_back();
+}
+
+bool RealNumber::IsOne(const Limbs &a) {
+    return a.size() == 1 && a[0] == 1;
 }
 
-std::string RealNumber::MulBig(const std::string &a, const std::string &b) {
-    int na = a.size(), nb = b.size();
-    std::vector<int> prod(na + nb);
-    for (int i = na - 1; i >= 0; --i) {
-        for (int j = nb - 1; j >= 0; --j) {
-            prod[i + j + 1] += (a[i] - '0') * (b[j] - '0');
+RealNumber::Limbs RealNumber::FromUnsigned(unsigned long long x) {
+    Limbs res;
+    while (x != 0) {
+        res.push_back(static_cast<Limb>(x));
+        x >>= kLimbBits;
+    }
+    return res;
+}
+
+RealNumber::Limbs RealNumber::Pow10(size_t n) {
+    Limbs res{1};
+    size_t chunks = n / kDecimalChunkDigits;
+    for (size_t level = 0; (chunks >> level) != 0; ++level) {
+        if ((chunks >> level) & 1) res = MulBig(res, Pow10Tree(level));
+    }
+    Limb tail = 1;
+    for (size_t i = n % kDecimalChunkDigits; i > 0; --i) tail *= 10;
+    MulSmall(res, tail);
+    return res;
+}
+
+// 10^(9 * 2^level). Each level is the square of the previous one; levels are
+// built on first use and shared by every later conversion.
+const RealNumber::Limbs& RealNumber::Pow10Tree(size_t level) {
+    static std::deque<Limbs> tree{FromUnsigned(kDecimalChunk)};
+    while (tree.size() <= level) {
+        tree.push_back(MulBig(tree.back(), tree.back()));
+    }
+    return tree[level];
+}
+
+// Splits the digit string at a power-of-ten boundary close to its middle,
+// so the work is dominated by a few large multiplications.
+RealNumber::Limbs RealNumber::ParseDecimal(std::string_view digits) {
+    if (digits.size() > kDecimalSplitThreshold * kDecimalChunkDigits) {
+        size_t level = 0;
+        while ((size_t(kDecimalChunkDigits) << (level + 1)) < digits.size()) ++level;
+        size_t low = size_t(kDecimalChunkDigits) << level;
+        Limbs res = MulBig(ParseDecimal(digits.substr(0, digits.size() - low)), Pow10Tree(level));
+        AddShifted(res, ParseDecimal(digits.substr(digits.size() - low)), 0);
+        return res;
+    }
+    Limbs res;
+    size_t first = digits.size() % kDecimalChunkDigits;
+    if (first == 0) first = kDecimalChunkDigits;
+    for (size_t pos = 0; pos < digits.size();) {
+        size_t len = pos == 0 ? std::min(first, digits.size()) : kDecimalChunkDigits;
+        Limb chunk = 0, scale = 1;
+        for (size_t i = 0; i < len; ++i) {
+            chunk = chunk * 10 + static_cast<Limb>(digits[pos + i] - '0');
+            scale *= 10;
         }
+        MulSmall(res, scale, chunk);
+        pos += len;
+    }
+    return res;
+}
+
+std::string RealNumber::FormatDecimal(const Limbs &a) {
+    if (a.empty()) return "0";
+    std::string out;
+    FormatDecimalInto(a, out, 0);
+    return out;
+}
+
+// Appends the digits of `a`, left-padded with zeros to `width`. Large values
+// are split by the largest cached power of ten with at most half their
+// limbs, and both halves are converted recursively.
+void RealNumber::FormatDecimalInto(const Limbs &a, std::string &out, size_t width) {
+    if (a.size() > kDecimalSplitThreshold) {
+        size_t level = 0;
+        while (2 * Pow10Tree(level + 1).size() <= a.size() + 1) ++level;
+        Limbs q, r;
+        DivmodBig(a, Pow10Tree(level), q, r);
+        size_t low = size_t(kDecimalChunkDigits) << level;
+        FormatDecimalInto(q, out, width > low ? width - low : 0);
+        FormatDecimalInto(r, out, low);
+        return;
+    }
+    Limbs rest = a;
+    std::vector<Limb> chunks;
+    while (!rest.empty()) {
+        chunks.push_back(DivmodSmall(rest, kDecimalChunk));
+    }
+    std::string s = chunks.empty() ? "" : std::to_string(chunks.back());
+    for (size_t i = chunks.size(); i-- > 1;) {
+        std::string part = std::to_string(chunks[i - 1]);
+        s.append(kDecimalChunkDigits - part.size(), '0');
+        s += part;
+    }
+    if (s.size() < width) out.append(width - s.size(), '0');
+    out += s;
+}
+
+int RealNumber::CompareBig(const Limbs &a, const Limbs &b) {
+    if (a.size() != b.size()) return a.size() < b.size() ? -1 : 1;
+    for (size_t i = a.size(); i-- > 0;) {
+        if (a[i] != b[i]) return a[i] < b[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+bool RealNumber::LessThanBig(const Limbs &a, const Limbs &b) {
+    return CompareBig(a, b) < 0;
+}
+
+RealNumber::Limbs RealNumber::AddBig(const Limbs &a, const Limbs &b) {
+    const Limbs &longer = a.size() >= b.size() ? a : b;
+    const Limbs &shorter = a.size() >= b.size() ? b : a;
+    Limbs c(longer.size() + 1);
+    DoubleLimb carry = 0;
+    for (size_t i = 0; i < longer.size(); ++i) {
+        DoubleLimb sum = DoubleLimb(longer[i]) + (i < shorter.size() ? shorter[i] : 0) + carry;
+        c[i] = static_cast<Limb>(sum);
+        carry = sum >> kLimbBits;
+    }
+    c[longer.size()] = static_cast<Limb>(carry);
+    Normalize(c);
+    return c;
+}
+
+// Requires a >= b.
+RealNumber::Limbs RealNumber::SubBig(const Limbs &a, const Limbs &b) {
+    Limbs c(a.size());
+    Limb borrow = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        DoubleLimb sub = DoubleLimb(i < b.size() ? b[i] : 0) + borrow;
+        c[i] = static_cast<Limb>(a[i] - sub);
+        borrow = DoubleLimb(a[i]) < sub ? 1 : 0;
     }
-    for (int i = na + nb - 1; i > 0; --i) {
-        int carry = prod[i] / 10;
-        prod[i - 1] += carry;
-        prod[i] %= 10;
-    }
-    std::string C;
-    for (int x : prod) C.push_back(char('0' + x));
-    return Normalize(C);
-}
-
-void RealNumber::DivmodBig(const std::string &a, const std::string &b,
-                          std::string &q, std::string &r) {
-    if (b == "0") throw std::runtime_error("division by zero");
-    q.clear();
-    r.clear();
-    for (char c : a) {
-        r.push_back(c);
-        r = Normalize(r);
-        int x = 0;
-        while (r.size() > b.size() || (r.size() == b.size() && r >= b)) {
-            r = SubBig(r, b);
-            ++x;
+    Normalize(c);
+    return c;
+}
+
+RealNumber::Limbs RealNumber::MulBig(const Limbs &a, const Limbs &b) {
+    if (a.empty() || b.empty()) return {};
+    size_t n = std::min(a.size(), b.size());
+    if (n < kKaratsubaThreshold) return MulSchoolbook(a, b);
+    if (n >= kNttThreshold && a.size() + b.size() <= kNttMaxLength) return MulNtt(a, b);
+    if (2 * n <= std::max(a.size(), b.size())) return MulUnbalanced(a, b);
+    if (n < kToom3Threshold) return MulKaratsuba(a, b);
+    return MulToom3(a, b);
+}
+
+RealNumber::Limbs RealNumber::MulSchoolbook(const Limbs &a, const Limbs &b) {
+    if (a.empty() || b.empty()) return {};
+    Limbs c(a.size() + b.size());
+    for (size_t i = 0; i < a.size(); ++i) {
+        DoubleLimb carry = 0;
+        for (size_t j = 0; j < b.size(); ++j) {
+            DoubleLimb t = DoubleLimb(a[i]) * b[j] + c[i + j] + carry;
+            c[i + j] = static_cast<Limb>(t);
+            carry = t >> kLimbBits;
         }
-        q.push_back(char('0' + x));
+        c[i + b.size()] = static_cast<Limb>(carry);
     }
-    q = Normalize(q);
-    if (q.empty()) q = "0";
-    if (r.empty()) r = "0";
+    Normalize(c);
+    return c;
 }
 
-std::string RealNumber::GcdBig(std::string a, std::string b) {
-    while (b != "0") {
-        std::string q, r;
+// a * b = z2 * B^2k + ((a0 + a1)(b0 + b1) - z0 - z2) * B^k + z0
+RealNumber::Limbs RealNumber::MulKaratsuba(const Limbs &a, const Limbs &b) {
+    size_t k = (std::max(a.size(), b.size()) + 1) / 2;
+    Limbs a0 = SliceLimbs(a, 0, k), a1 = SliceLimbs(a, k, a.size());
+    Limbs b0 = SliceLimbs(b, 0, k), b1 = SliceLimbs(b, k, b.size());
+    Limbs z0 = MulBig(a0, b0);
+    Limbs z2 = MulBig(a1, b1);
+    Limbs z1 = MulBig(AddBig(a0, a1), AddBig(b0, b1));
+    z1 = SubBig(SubBig(z1, z0), z2);
+    Limbs res = std::move(z0);
+    res.reserve(a.size() + b.size() + 1);
+    AddShifted(res, z1, k);
+    AddShifted(res, z2, 2 * k);
+    return res;
+}
+
+// Toom-Cook 3-way: evaluate both operands at 0, 1, -1, -2 and infinity,
+// multiply pointwise and interpolate with Bodrato's sequence.
+RealNumber::Limbs RealNumber::MulToom3(const Limbs &a, const Limbs &b) {
+    size_t k = (std::max(a.size(), b.size()) + 2) / 3;
+    auto evaluate = [k](const Limbs &x, SignedLimbs points[5]) {
+        SignedLimbs x0{SliceLimbs(x, 0, k)};
+        SignedLimbs x1{SliceLimbs(x, k, k)};
+        SignedLimbs x2{SliceLimbs(x, 2 * k, x.size())};
+        SignedLimbs even = AddSigned(x0, x2);
+        points[0] = x0;
+        points[1] = AddSigned(even, x1);
+        points[2] = SubSigned(even, x1);
+        SignedLimbs m2 = AddSigned(points[2], x2);
+        MulSmall(m2.mag, 2);
+        points[3] = SubSigned(m2, x0);
+        points[4] = x2;
+    };
+    SignedLimbs pa[5], pb[5], r[5];
+    evaluate(a, pa);
+    evaluate(b, pb);
+    for (int i = 0; i < 5; ++i) {
+        r[i].mag = MulBig(pa[i].mag, pb[i].mag);
+        r[i].negative = !r[i].mag.empty() && pa[i].negative != pb[i].negative;
+    }
+    // r = {r(0), r(1), r(-1), r(-2), r(inf)}
+    SignedLimbs c0 = r[0], c4 = r[4];
+    SignedLimbs c3 = SubSigned(r[3], r[1]);
+    DivmodSmall(c3.mag, 3);
+    SignedLimbs c1 = SubSigned(r[1], r[2]);
+    DivmodSmall(c1.mag, 2);
+    SignedLimbs c2 = SubSigned(r[2], r[0]);
+    c3 = SubSigned(c2, c3);
+    DivmodSmall(c3.mag, 2);
+    SignedLimbs twoInf = c4;
+    MulSmall(twoInf.mag, 2);
+    c3 = AddSigned(c3, twoInf);
+    c2 = SubSigned(AddSigned(c2, c1), c4);
+    c1 = SubSigned(c1, c3);
+
+    Limbs res = std::move(c0.mag);
+    res.reserve(a.size() + b.size() + 1);
+    AddShifted(res, c1.mag, k);
+    AddShifted(res, c2.mag, 2 * k);
+    AddShifted(res, c3.mag, 3 * k);
+    AddShifted(res, c4.mag, 4 * k);
+    return res;
+}
+
+// Splits the longer operand into pieces the size of the shorter one so the
+// recursive algorithms always see balanced inputs.
+RealNumber::Limbs RealNumber::MulUnbalanced(const Limbs &a, const Limbs &b) {
+    const Limbs &longer = a.size() >= b.size() ? a : b;
+    const Limbs &shorter = a.size() >= b.size() ? b : a;
+    Limbs res;
+    res.reserve(a.size() + b.size());
+    for (size_t pos = 0; pos < longer.size(); pos += shorter.size()) {
+        Limbs piece = SliceLimbs(longer, pos, shorter.size());
+        AddShifted(res, MulBig(piece, shorter), pos);
+    }
+    return res;
+}
+
+namespace {
+
+uint32_t PowMod(uint64_t base, uint64_t exp, uint32_t mod) {
+    uint64_t res = 1;
+    base %= mod;
+    while (exp > 0) {
+        if (exp & 1) res = res * base % mod;
+        base = base * base % mod;
+        exp >>= 1;
+    }
+    return static_cast<uint32_t>(res);
+}
+
+// NTT-friendly primes p = c * 2^k + 1 with primitive root 3; all of them
+// support transforms of length up to 2^23.
+constexpr uint32_t kNttPrimes[3] = {998244353, 167772161, 469762049};
+constexpr uint32_t kNttRoot = 3;
+
+}  // namespace
+
+template <uint32_t Mod>
+void RealNumber::Ntt(std::vector<uint32_t> &a, bool invert) {
+    constexpr uint64_t mod = Mod;
+    size_t n = a.size();
+    for (size_t i = 1, j = 0; i < n; ++i) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) std::swap(a[i], a[j]);
+    }
+    std::vector<uint32_t> w(n / 2);
+    for (size_t len = 2; len <= n; len <<= 1) {
+        uint64_t step = PowMod(kNttRoot, (mod - 1) / len, Mod);
+        if (invert) step = PowMod(step, mod - 2, Mod);
+        size_t half = len / 2;
+        w[0] = 1;
+        for (size_t k = 1; k < half; ++k) w[k] = static_cast<uint32_t>(w[k - 1] * step % mod);
+        for (size_t i = 0; i < n; i += len) {
+            for (size_t k = 0; k < half; ++k) {
+                uint32_t u = a[i + k];
+                uint32_t v = static_cast<uint32_t>(uint64_t(a[i + k + half]) * w[k] % mod);
+                a[i + k] = u + v >= Mod ? u + v - Mod : u + v;
+                a[i + k + half] = u >= v ? u - v : u + Mod - v;
+            }
+        }
+    }
+    if (invert) {
+        uint64_t nInv = PowMod(n, mod - 2, Mod);
+        for (uint32_t &x : a) x = static_cast<uint32_t>(x * nInv % mod);
+    }
+}
+
+template <uint32_t Mod>
+std::vector<uint32_t> RealNumber::ConvolveMod(const std::vector<uint32_t> &a,
+                                              const std::vector<uint32_t> &b, size_t n) {
+    std::vector<uint32_t> fa(n, 0), fb(n, 0);
+    for (size_t i = 0; i < a.size(); ++i) fa[i] = a[i] % Mod;
+    for (size_t i = 0; i < b.size(); ++i) fb[i] = b[i] % Mod;
+    Ntt<Mod>(fa, false);
+    Ntt<Mod>(fb, false);
+    for (size_t i = 0; i < n; ++i) fa[i] = static_cast<uint32_t>(uint64_t(fa[i]) * fb[i] % Mod);
+    Ntt<Mod>(fa, true);
+    return fa;
+}
+
+// Multiplies via number-theoretic transforms modulo three primes and rebuilds
+// each exact convolution coefficient with Garner's CRT before carrying. A
+// coefficient is below min(|a|, |b|) * 2^64, which the ~2^86 product of the
+// primes covers for any operand the transform length allows, so no floating
+// point (and no rounding error) is involved.
+RealNumber::Limbs RealNumber::MulNtt(const Limbs &a, const Limbs &b) {
+    size_t resultSize = a.size() + b.size() - 1;
+    size_t n = 1;
+    while (n < resultSize) n <<= 1;
+
+    std::vector<uint32_t> conv[3] = {
+        ConvolveMod<kNttPrimes[0]>(a, b, n),
+        ConvolveMod<kNttPrimes[1]>(a, b, n),
+        ConvolveMod<kNttPrimes[2]>(a, b, n),
+    };
+
+    const uint64_t m0 = kNttPrimes[0], m1 = kNttPrimes[1], m2 = kNttPrimes[2];
+    const uint64_t m0InvM1 = PowMod(m0, m1 - 2, m1);
+    const uint64_t m01InvM2 = PowMod(m0 * m1 % m2, m2 - 2, m2);
+    Limbs res(resultSize + 1, 0);
+    unsigned __int128 carry = 0;
+    for (size_t i = 0; i < res.size(); ++i) {
+        if (i < resultSize) {
+            uint64_t r0 = conv[0][i], r1 = conv[1][i], r2 = conv[2][i];
+            uint64_t t1 = (r1 + m1 - r0 % m1) % m1 * m0InvM1 % m1;
+            uint64_t x01 = r0 + t1 * m0;
+            uint64_t t2 = (r2 + m2 - x01 % m2) % m2 * m01InvM2 % m2;
+            carry += static_cast<unsigned __int128>(t2) * (m0 * m1) + x01;
+        }
+        res[i] = static_cast<Limb>(carry);
+        carry >>= kLimbBits;
+    }
+    Normalize(res);
+    return res;
+}
+
+RealNumber::Limbs RealNumber::SliceLimbs(const Limbs &a, size_t from, size_t count) {
+    if (from >= a.size()) return {};
+    size_t to = std::min(a.size(), from + count);
+    Limbs res(a.begin() + from, a.begin() + to);
+    Normalize(res);
+    return res;
+}
+
+void RealNumber::AddShifted(Limbs &acc, const Limbs &x, size_t shift) {
+    if (x.empty()) return;
+    if (acc.size() < x.size() + shift) acc.resize(x.size() + shift, 0);
+    DoubleLimb carry = 0;
+    size_t i = 0;
+    for (; i < x.size(); ++i) {
+        DoubleLimb sum = DoubleLimb(acc[shift + i]) + x[i] + carry;
+        acc[shift + i] = static_cast<Limb>(sum);
+        carry = sum >> kLimbBits;
+    }
+    for (size_t j = shift + i; carry != 0; ++j) {
+        if (j == acc.size()) acc.push_back(0);
+        DoubleLimb sum = DoubleLimb(acc[j]) + carry;
+        acc[j] = static_cast<Limb>(sum);
+        carry = sum >> kLimbBits;
+    }
+    Normalize(acc);
+}
+
+RealNumber::SignedLimbs RealNumber::AddSigned(const SignedLimbs &a, const SignedLimbs &b) {
+    if (a.negative == b.negative) {
+        return {AddBig(a.mag, b.mag), a.negative};
+    }
+    int cmp = CompareBig(a.mag, b.mag);
+    if (cmp == 0) return {};
+    if (cmp > 0) return {SubBig(a.mag, b.mag), a.negative};
+    return {SubBig(b.mag, a.mag), b.negative};
+}
+
+RealNumber::SignedLimbs RealNumber::SubSigned(const SignedLimbs &a, const SignedLimbs &b) {
+    SignedLimbs negated = b;
+    negated.negative = !b.negative && !b.mag.empty();
+    return AddSigned(a, negated);
+}
+
+void RealNumber::MulSmall(Limbs &a, Limb m, Limb add) {
+    DoubleLimb carry = add;
+    for (Limb &x : a) {
+        DoubleLimb t = DoubleLimb(x) * m + carry;
+        x = static_cast<Limb>(t);
+        carry = t >> kLimbBits;
+    }
+    if (carry != 0) a.push_back(static_cast<Limb>(carry));
+    Normalize(a);
+}
+
+RealNumber::Limb RealNumber::DivmodSmall(Limbs &a, Limb d) {
+    DoubleLimb rem = 0;
+    for (size_t i = a.size(); i-- > 0;) {
+        DoubleLimb cur = (rem << kLimbBits) | a[i];
+        a[i] = static_cast<Limb>(cur / d);
+        rem = cur % d;
+    }
+    Normalize(a);
+    return static_cast<Limb>(rem);
+}
+
+void RealNumber::DivmodBig(const Limbs &a, const Limbs &b, Limbs &q, Limbs &r) {
+    if (b.empty()) throw std::runtime_error("division by zero");
+    if (LessThanBig(a, b)) {
+        r = a;
+        q.clear();
+        return;
+    }
+    if (b.size() == 1) {
+        Limbs quot = a;
+        Limb rem = DivmodSmall(quot, b[0]);
+        q = std::move(quot);
+        r = rem != 0 ? Limbs{rem} : Limbs{};
+        return;
+    }
+    if (b.size() > kBurnikelZieglerThreshold &&
+        a.size() - b.size() > kBurnikelZieglerThreshold) {
+        DivmodBurnikelZiegler(a, b, q, r);
+        return;
+    }
+    DivmodKnuth(a, b, q, r);
+}
+
+// Knuth's Algorithm D (TAOCP 4.3.1): normalize so the divisor's top bit is
+// set, estimate each quotient limb from the top two limbs of the running
+// remainder, and correct the rare overestimate with one add-back.
+void RealNumber::DivmodKnuth(const Limbs &a, const Limbs &b, Limbs &q, Limbs &r) {
+    if (LessThanBig(a, b)) {
+        r = a;
+        q.clear();
+        return;
+    }
+    if (b.size() == 1) {
         DivmodBig(a, b, q, r);
-        a = std::move(b);
-        b = std::move(r);
+        return;
     }
-    return a;
+    int shift = std::countl_zero(b.back());
+    Limbs v = ShiftLeft(b, shift);
+    Limbs u = ShiftLeft(a, shift);
+    u.resize(a.size() + 1, 0);
+    size_t n = v.size();
+    size_t m = a.size() - n;
+    Limbs quot(m + 1, 0);
+    for (size_t j = m + 1; j-- > 0;) {
+        DoubleLimb num = (DoubleLimb(u[j + n]) << kLimbBits) | u[j + n - 1];
+        DoubleLimb qhat = num / v[n - 1];
+        DoubleLimb rhat = num % v[n - 1];
+        while ((qhat >> kLimbBits) != 0 ||
+               qhat * v[n - 2] > ((rhat << kLimbBits) | u[j + n - 2])) {
+            --qhat;
+            rhat += v[n - 1];
+            if ((rhat >> kLimbBits) != 0) break;
+        }
+        int64_t borrow = 0;
+        DoubleLimb carry = 0;
+        for (size_t i = 0; i < n; ++i) {
+            DoubleLimb p = qhat * v[i] + carry;
+            carry = p >> kLimbBits;
+            int64_t t = int64_t(u[i + j]) - int64_t(p & 0xFFFFFFFFu) - borrow;
+            u[i + j] = static_cast<Limb>(t);
+            borrow = t < 0 ? 1 : 0;
+        }
+        int64_t t = int64_t(u[j + n]) - int64_t(carry) - borrow;
+        u[j + n] = static_cast<Limb>(t);
+        if (t < 0) {
+            --qhat;
+            DoubleLimb c = 0;
+            for (size_t i = 0; i < n; ++i) {
+                DoubleLimb sum = DoubleLimb(u[i + j]) + v[i] + c;
+                u[i + j] = static_cast<Limb>(sum);
+                c = sum >> kLimbBits;
+            }
+            u[j + n] += static_cast<Limb>(c);
+        }
+        quot[j] = static_cast<Limb>(qhat);
+    }
+    u.resize(n);
+    Normalize(u);
+    Normalize(quot);
+    q = std::move(quot);
+    r = ShiftRight(u, shift);
+}
+
+// Burnikel-Ziegler recursive division ("Fast Recursive Division", 1998).
+// The divisor is padded to n = j * 2^k limbs (j <= threshold) with its top
+// bit set, and the dividend is consumed in n-limb blocks by Div2n1n, which
+// halves the problem until Algorithm D takes over. The multiplications this
+// generates run through MulBig, so large divisions inherit the
+// subquadratic multipliers.
+void RealNumber::DivmodBurnikelZiegler(const Limbs &a, const Limbs &b, Limbs &q, Limbs &r) {
+    size_t s = b.size();
+    size_t k = 0;
+    while (((s + (size_t(1) << k) - 1) >> k) > kBurnikelZieglerThreshold) ++k;
+    size_t n = ((s + (size_t(1) << k) - 1) >> k) << k;
+    size_t sigma = (n - s) * kLimbBits + std::countl_zero(b.back());
+    Limbs bn = ShiftLeft(b, sigma);
+    Limbs an = ShiftLeft(a, sigma);
+
+    size_t bits = an.size() * kLimbBits - std::countl_zero(an.back());
+    size_t t = std::max<size_t>(2, (bits + 1 + n * kLimbBits - 1) / (n * kLimbBits));
+
+    Limbs z = SliceLimbs(an, (t - 2) * n, 2 * n);
+    Limbs quot, rem;
+    for (size_t i = t - 1; i-- > 0;) {
+        Limbs qi;
+        Div2n1n(z, bn, n, qi, rem);
+        AddShifted(quot, qi, i * n);
+        if (i > 0) {
+            z = ShiftLeft(rem, n * kLimbBits);
+            AddShifted(z, SliceLimbs(an, (i - 1) * n, n), 0);
+        }
+    }
+    q = std::move(quot);
+    r = ShiftRight(rem, sigma);
+}
+
+// Requires a < b * B^n, where b has exactly n limbs and its top bit set.
+void RealNumber::Div2n1n(const Limbs &a, const Limbs &b, size_t n, Limbs &q, Limbs &r) {
+    if (n % 2 != 0 || n <= kBurnikelZieglerThreshold) {
+        DivmodKnuth(a, b, q, r);
+        return;
+    }
+    size_t h = n / 2;
+    Limbs q1, q2, rem;
+    Div3n2n(SliceLimbs(a, h, 3 * h), b, h, q1, rem);
+    Limbs next = ShiftLeft(rem, h * kLimbBits);
+    AddShifted(next, SliceLimbs(a, 0, h), 0);
+    Div3n2n(next, b, h, q2, r);
+    q = ShiftLeft(q1, h * kLimbBits);
+    AddShifted(q, q2, 0);
 }
 
-void RealNumber::Reduce() {
-    if (den_ == "0") throw std::runtime_error("division by zero");
-    std::string g = GcdBig(num_, den_);
-    if (g != "1") {
-        std::string q1, r1, q2, r2;
+// Requires a < b * B^h, where b has exactly 2h limbs and its top bit set.
+void RealNumber::Div3n2n(const Limbs &a, const Limbs &b, size_t h, Limbs &q, Limbs &r) {
+    Limbs a12 = SliceLimbs(a, h, 2 * h);
+    Limbs b1 = SliceLimbs(b, h, h);
+    Limbs b2 = SliceLimbs(b, 0, h);
+    Limbs qhat, r1;
+    if (LessThanBig(SliceLimbs(a, 2 * h, h), b1)) {
+        Div2n1n(a12, b1, h, qhat, r1);
+    } else {
+        qhat.assign(h, ~Limb(0));
+        r1 = AddBig(SubBig(a12, ShiftLeft(b1, h * kLimbBits)), b1);
+    }
+    Limbs d = MulBig(qhat, b2);
+    Limbs x = ShiftLeft(r1, h * kLimbBits);
+    AddShifted(x, SliceLimbs(a, 0, h), 0);
+    while (LessThanBig(x, d)) {
+        x = AddBig(x, b);
+        qhat = SubBig(qhat, {1});
+    }
+    q = std::move(qhat);
+    r = SubBig(x, d);
+}
+
+RealNumber::Limbs RealNumber::ShiftLeft(const Limbs &a, size_t bits) {
+    if (a.empty()) return {};
+    size_t limbs = bits / kLimbBits, rest = bits % kLimbBits;
+    Limbs res(a.size() + limbs + 1, 0);
+    for (size_t i = 0; i < a.size(); ++i) {
+        DoubleLimb shifted = DoubleLimb(a[i]) << rest;
+        res[i + limbs] |= static_cast<Limb>(shifted);
+        res[i + limbs + 1] = static_cast<Limb>(shifted >> kLimbBits);
+    }
+    Normalize(res);
+    return res;
+}
+
+RealNumber::Limbs RealNumber::ShiftRight(const Limbs &a, size_t bits) {
+    size_t limbs = bits / kLimbBits, rest = bits % kLimbBits;
+    if (limbs >= a.size()) return {};
+    Limbs res(a.size() - limbs);
+    for (size_t i = 0; i < res.size(); ++i) {
+        DoubleLimb cur = a[i + limbs];
+        if (i + limbs + 1 < a.size()) cur |= DoubleLimb(a[i + limbs + 1]) << kLimbBits;
+        res[i] = static_cast<Limb>(cur >> rest);
+    }
+    Normalize(res);
+    return res;
+}
+
+// Lehmer's GCD (Knuth, TAOCP 4.5.2, Algorithm L). The Euclidean quotient
+// sequence is simulated on the leading 62 bits of both operands while it
+// provably agrees with the full-precision one; the accumulated cofactors are
+// then applied to the operands in a single linear pass, replacing dozens of
+// DivmodBig calls. Once both values fit in 64 bits the rest is native.
+RealNumber::Limbs RealNumber::GcdBig(Limbs a, Limbs b) {
+    if (LessThanBig(a, b)) std::swap(a, b);
+    while (b.size() > 2) {
+        size_t bits = a.size() * kLimbBits - std::countl_zero(a.back());
+        size_t shift = bits - 62;
+        auto leading = [shift](const Limbs &x) {
+            size_t limb = shift / kLimbBits, rest = shift % kLimbBits;
+            unsigned __int128 window = 0;
+            for (size_t i = std::min(x.size(), limb + 3); i-- > limb;) {
+                window = (window << kLimbBits) | x[i];
+            }
+            return static_cast<int64_t>(window >> rest);
+        };
+        int64_t x = leading(a), y = leading(b);
+        int64_t ca = 1, cb = 0, cc = 0, cd = 1;
+        while (y + cc != 0 && y + cd != 0) {
+            int64_t q = (x + ca) / (y + cc);
+            if (q != (x + cb) / (y + cd)) break;
+            int64_t t = ca - q * cc;
+            ca = cc;
+            cc = t;
+            t = cb - q * cd;
+            cb = cd;
+            cd = t;
+            t = x - q * y;
+            x = y;
+            y = t;
+        }
+        if (cb == 0) {
+            Limbs q, r;
+            DivmodBig(a, b, q, r);
+            a = std::move(b);
+            b = std::move(r);
+        } else {
+            Limbs na = LinearCombination(a, ca, b, cb);
+            b = LinearCombination(a, cc, b, cd);
+            a = std::move(na);
+        }
+    }
+    if (b.empty()) return a;
+    Limbs q, r;
+    DivmodBig(a, b, q, r);
+    auto to_u64 = [](const Limbs &x) {
+        uint64_t v = 0;
+        for (size_t i = x.size(); i-- > 0;) v = (v << kLimbBits) | x[i];
+        return v;
+    };
+    return FromUnsigned(std::gcd(to_u64(b), to_u64(r)));
+}
+
+// ca * a + cb * b for cofactors produced by GcdBig; the caller guarantees
+// the result is non-negative.
+RealNumber::Limbs RealNumber::LinearCombination(const Limbs &a, int64_t ca,
+                                                const Limbs &b, int64_t cb) {
+    size_t n = std::max(a.size(), b.size());
+    Limbs res(n + 2, 0);
+    __int128 carry = 0;
+    for (size_t i = 0; i < res.size(); ++i) {
+        __int128 cur = carry;
+        if (i < a.size()) cur += static_cast<__int128>(ca) * a[i];
+        if (i < b.size()) cur += static_cast<__int128>(cb) * b[i];
+        res[i] = static_cast<Limb>(cur);
+        carry = cur >> kLimbBits;
+    }
+    Normalize(res);
+    return res;
+}
+
+void RealNumber::Reduce() const {
+    pending_ = 0;
+    if (den_.empty()) throw std::runtime_error("division by zero");
+    if (num_.empty()) {
+        den_.clear();
+        negative_ = false;
+        is_small_ = true;
+        small_ = 0;
+        return;
+    }
+    if (IsOne(den_)) {
+        TryInline();
+        return;
+    }
+    Limbs g = GcdBig(num_, den_);
+    if (!IsOne(g)) {
+        Limbs q1, r1, q2, r2;
         DivmodBig(num_, g, q1, r1);
         DivmodBig(den_, g, q2, r2);
-        num_ = q1;
-        den_ = q2;
+        num_ = std::move(q1);
+        den_ = std::move(q2);
     }
-    if (num_ == "0") {
-        negative_ = false;
-        den_ = "1";
+    reduced_limbs_ = num_.size() + den_.size();
+    TryInline();
+}
+
+// Integers (den == 1) are already in lowest terms, so only fractions count
+// against the budget.
+void RealNumber::ReduceLazily() {
+    if (num_.empty() || IsOne(den_) ||
+        ++pending_ >= reduce_budget_.ops ||
+        num_.size() + den_.size() > reduced_limbs_ + reduce_budget_.limbs) {
+        Reduce();
     }
-}
\ No newline at end of file
+}
+
+void RealNumber::Canonicalize() const {
+    if (pending_ != 0) Reduce();
+}
+
+void RealNumber::SetPrecision(size_t digits) {
+    precision_ = digits;
+}
+
+size_t RealNumber::GetPrecision() {
+    return precision_;
+}
+
+size_t RealNumber::BitLength(const Limbs &a) {
+    return a.empty() ? 0 : a.size() * kLimbBits - std::countl_zero(a.back());
+}
+
+// Newton's iteration x' = (x + a / x) / 2, started above sqrt(a) so the
+// sequence decreases monotonically to floor(sqrt(a)).
+RealNumber::Limbs RealNumber::Isqrt(const Limbs &a) {
+    if (a.empty()) return {};
+    Limbs x = ShiftLeft({1}, (BitLength(a) + 1) / 2);
+    while (true) {
+        Limbs q, r;
+        DivmodBig(a, x, q, r);
+        Limbs next = ShiftRight(AddBig(x, q), 1);
+        if (!LessThanBig(next, x)) return x;
+        x = std::move(next);
+    }
+}
+
+// atanh(z) = z + z^3/3 + z^5/5 + ..., for a fixed-point 0 <= z <= 1/3.
+RealNumber::Limbs RealNumber::AtanhFixed(const Limbs &z, size_t bits) {
+    Limbs z2 = ShiftRight(MulBig(z, z), bits);
+    Limbs power = z;
+    Limbs sum = z;
+    for (Limb k = 3;; k += 2) {
+        power = ShiftRight(MulBig(power, z2), bits);
+        Limbs term = power;
+        DivmodSmall(term, k);
+        if (term.empty()) break;
+        sum = AddBig(sum, term);
+    }
+    return sum;
+}
+
+// ln 2 = 2 atanh(1/3).
+RealNumber::Limbs RealNumber::Ln2Fixed(size_t bits) {
+    Limbs third = ShiftLeft({1}, bits);
+    DivmodSmall(third, 3);
+    return ShiftLeft(AtanhFixed(third, bits), 1);
+}
+
+// ln(num / den) * 2^bits. The argument is scaled by 2^e into [1/2, 2), where
+// ln m = 2 atanh((m - 1) / (m + 1)) converges by a factor of 9 per term.
+RealNumber::SignedLimbs RealNumber::LnFixed(const Limbs &num, const Limbs &den, size_t bits) {
+    long long e = static_cast<long long>(BitLength(num)) - static_cast<long long>(BitLength(den));
+    size_t ebits = BitLength(FromUnsigned(static_cast<unsigned long long>(std::llabs(e))));
+    size_t work = bits + ebits + 32;
+    Limbs a = e < 0 ? ShiftLeft(num, static_cast<size_t>(-e)) : num;
+    Limbs b = e > 0 ? ShiftLeft(den, static_cast<size_t>(e)) : den;
+    SignedLimbs diff = SubSigned({a, false}, {b, false});
+    Limbs z, unused;
+    DivmodBig(ShiftLeft(diff.mag, work), AddBig(a, b), z, unused);
+    SignedLimbs res{ShiftLeft(AtanhFixed(z, work), 1), diff.negative};
+    if (e != 0) {
+        Limbs scaled = MulBig(Ln2Fixed(work), FromUnsigned(static_cast<unsigned long long>(std::llabs(e))));
+        res = AddSigned(res, {scaled, e < 0});
+    }
+    res.mag = ShiftRight(res.mag, work - bits);
+    if (res.mag.empty()) res.negative = false;
+    return res;
+}
+
+// exp(t / 2^bits) = result * 2^exponent / 2^bits. t is split as k ln 2 + r
+// with |r| <= ln 2 / 2; exp(r / 2^16) comes from its Taylor series and is
+// squared back 16 times.
+RealNumber::Limbs RealNumber::ExpFixed(const SignedLimbs &t, size_t bits, long long &exponent) {
+    constexpr size_t kSquarings = 16;
+    size_t kbits = BitLength(ShiftRight(t.mag, bits)) + 2;
+    size_t work = bits + kbits + kSquarings + 32;
+    Limbs ln2 = Ln2Fixed(work);
+    Limbs tw = ShiftLeft(t.mag, work - bits);
+    Limbs k, unused;
+    DivmodBig(AddBig(tw, ShiftRight(ln2, 1)), ln2, k, unused);
+    SignedLimbs r = SubSigned({tw, false}, {MulBig(k, ln2), false});
+    unsigned long long kval = 0;
+    for (size_t i = k.size(); i-- > 0;) kval = (kval << kLimbBits) | k[i];
+    exponent = t.negative ? -static_cast<long long>(kval) : static_cast<long long>(kval);
+    bool invert = r.negative != t.negative;
+
+    Limbs x = ShiftRight(r.mag, kSquarings);
+    Limbs term = ShiftLeft({1}, work);
+    Limbs sum = term;
+    for (Limb n = 1;; ++n) {
+        term = ShiftRight(MulBig(term, x), work);
+        DivmodSmall(term, n);
+        if (term.empty()) break;
+        sum = AddBig(sum, term);
+    }
+    for (size_t i = 0; i < kSquarings; ++i) {
+        sum = ShiftRight(MulBig(sum, sum), work);
+    }
+    if (invert) {
+        Limbs q;
+        DivmodBig(ShiftLeft({1}, 2 * work), sum, q, unused);
+        sum = std::move(q);
+    }
+    return ShiftRight(sum, work - bits);
+}
+
+void RealNumber::SetReduceBudget(ReduceBudget budget) {
+    if (budget.ops == 0) budget.ops = 1;
+    reduce_budget_ = budget;
+}
+
+RealNumber::ReduceBudget RealNumber::GetReduceBudget() {
+    return reduce_budget_;
+}
@@ -2,89 +2,58 @@
 #define _ITMOSCRIPT_LIB_REAL_NUMBER_HPP_
 
 #include <cmath>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <stdexcept>
 #include <vector>
 #include <sstream>
 #include <iomanip>
 #include <iostream>
-#include <unordered_map>
 
+// Arbitrary-precision rational number. Numerator and denominator are kept as
+// little-endian vectors of 32-bit limbs (an empty vector is zero); decimal
+// digits only appear when the number is parsed or converted to a string.
+//
+// Integers in [-LLONG_MAX, LLONG_MAX] are stored inline in small_ and use
+// native arithmetic with overflow checks; a result that does not fit is
+// promoted to the limb representation, and a limb result that fits is
+// demoted back, so every value has exactly one representation.
+//
+// Arithmetic does not reduce fractions to lowest terms immediately: a result
+// may stay unreduced for a bounded number of operations (see ReduceBudget),
+// and is brought into canonical form before it is compared for equality,
+// printed or converted.
 class RealNumber {
 public:
-    RealNumber() : num_("0"), den_("1"), negative_(false) {}
+    // How far a fraction may drift from lowest terms before arithmetic pays
+    // for a GCD: at most `ops` consecutive operations, and numerator plus
+    // denominator at most `limbs` limbs longer than after the last
+    // reduction. ops == 1 reduces eagerly.
+    struct ReduceBudget {
+        uint32_t ops = 32;
+        size_t limbs = 64;
+    };
+
+    static void SetReduceBudget(ReduceBudget budget);
+    static ReduceBudget GetReduceBudget();
+
+    // Decimal places kept by operations whose exact result is generally
+    // irrational: sqrt() and powers with a non-integer exponent. Results are
+    // rounded to this many places (10 by default).
+    static void SetPrecision(size_t digits);
+    static size_t GetPrecision();
+
+    RealNumber() : negative_(false), is_small_(true), small_(0) {}
     RealNumber(long long x);
     RealNumber(const std::string &s);
 
     template <typename T>
     T convert_to() const {
         if constexpr(std::is_same_v<T, std::string>) {
-            std::string s;
-            if (negative_ && num_ != "0") s.push_back('-');
-            std::string q, r;
-            DivmodBig(num_, den_, q, r);
-            if (q.empty()) q = "0";
-            s += q;
-            if (r != "0") {
-                s.push_back('.');
-                std::string dcopy = den_;
-                while (true) {
-                    std::string tmpq, tmpr;
-                    DivmodBig(dcopy, "2", tmpq, tmpr);
-                    if (tmpr == "0") dcopy = tmpq;
-                    else break;
-                }
-                while (true) {
-                    std::string tmpq, tmpr;
-                    DivmodBig(dcopy, "5", tmpq, tmpr);
-                    if (tmpr == "0") dcopy = tmpq;
-                    else break;
-                }
-                bool isFinite = (dcopy == "1");
-                std::unordered_map<std::string, size_t> remPos;
-                std::vector<char> digits;
-                const size_t MAX_IRR_DIGITS = 15;
-                bool isPeriodic = false;
-                size_t cycleStart = 0;
-                size_t pos = 0;
-                std::string rem = r;
-                while (rem != "0") {
-                    if (!isFinite) {
-                        auto it = remPos.find(rem);
-                        if (it != remPos.end()) {
-                            isPeriodic = true;
-                            cycleStart = it->second;
-                            break;
-                        }
-                        remPos[rem] = pos++;
-                    }
-                    if (!isFinite && !isPeriodic && digits.size() >= MAX_IRR_DIGITS) {
-                        break;
-                    }
-                    rem.push_back('0');
-                    std::string dq, dr;
-                    DivmodBig(rem, den_, dq, dr);
-                    digits.push_back(dq.empty() ? '0' : dq.front());
-                    rem = dr;
-                }
-                if (rem == "0") {
-                    for (char c : digits) s.push_back(c);
-                } else if (isPeriodic) {
-                    for (size_t i = 0; i < cycleStart; ++i) s.push_back(digits[i]);
-                    s.push_back('(');
-                    for (size_t i = cycleStart; i < digits.size(); ++i) s.push_back(digits[i]);
-                    s.push_back(')');
-                } else {
-                    for (char c : digits) s.push_back(c);
-                }
-            }
-            return s;
+            return ToDecimalString();
         } else if constexpr(std::is_integral_v<T>) {
-            std::string q, r;
-            DivmodBig(num_, den_, q, r);
-            if (q.empty()) q = "0";
-            long long val = std::stoll(q);
-            return static_cast<T>(negative_ ? -val : val);
+            return static_cast<T>(ToInteger());
         } else {
             static_assert(!sizeof(T), "unsupported convert_to");
         }
@@ -122,6 +91,45 @@ public:
     explicit operator long long() const;
 
 private:
+    using Limb = uint32_t;
+    using DoubleLimb = uint64_t;
+    using Limbs = std::vector<Limb>;
+
+    static constexpr int kLimbBits = 32;
+    static constexpr Limb kDecimalChunk = 1000000000;
+    static constexpr int kDecimalChunkDigits = 9;
+    // Size (in limbs) below which decimal conversion works chunk by chunk
+    // instead of splitting on the cached powers of ten.
+    static constexpr size_t kDecimalSplitThreshold = 32;
+    // Fraction digits printed for a non-terminating expansion, including a
+    // repeating block when preperiod and period fit.
+    static constexpr size_t kMaxFractionDigits = 15;
+    // Largest result, in bits, that a non-integer power may produce.
+    static constexpr size_t kMaxPowerBits = size_t(1) << 24;
+
+    // Operand sizes (in limbs) at which MulBig switches algorithms, measured
+    // with -O2 on random operands.
+    static constexpr size_t kKaratsubaThreshold = 64;
+    static constexpr size_t kToom3Threshold = 256;
+    static constexpr size_t kNttThreshold = 2048;
+    static constexpr size_t kNttMaxLength = size_t(1) << 23;
+    // Divisor size (in limbs) above which DivmodBig recurses with
+    // Burnikel-Ziegler instead of running Algorithm D directly.
+    static constexpr size_t kBurnikelZieglerThreshold = 80;
+
+    struct SignedLimbs {
+        Limbs mag;
+        bool negative = false;
+    };
+
+    RealNumber(Limbs num, Limbs den, bool negative);
+
+    static bool FitsInline(long long v);
+    static const RealNumber& BigView(const RealNumber &o, RealNumber &tmp);
+    bool IsZero() const;
+    void Promote();
+    void TryInline() const;
+
     friend RealNumber operator+(RealNumber a, const RealNumber &b);
     friend RealNumber operator-(RealNumber a, const RealNumber &b);
     friend RealNumber operator*(RealNumber a, const RealNumber &b);
@@ -130,19 +138,70 @@ private:
     friend RealNumber operator%(const RealNumber &a, const RealNumber &b);
     friend std::ostream& operator<<(std::ostream& os, const RealNumber& v);
 
-    static std::string Normalize(const std::string &s);
-    static bool LessThanBig(const std::string &a, const std::string &b);
-    static std::string AddBig(const std::string &a, const std::string &b);
-    static std::string SubBig(const std::string &a, const std::string &b);
-    static std::string MulBig(const std::string &a, const std::string &b);
-    static void DivmodBig(const std::string &a, const std::string &b,
-                          std::string &q, std::string &r);
-    static std::string GcdBig(std::string a, std::string b);
-    void Reduce();
-
-    std::string num_;
-    std::string den_;
-    bool negative_;
+    std::string ToDecimalString() const;
+    long long ToInteger() const;
+
+    static void Normalize(Limbs &a);
+    static bool IsOne(const Limbs &a);
+    static Limbs FromUnsigned(unsigned long long x);
+    static Limbs Pow10(size_t n);
+    static const Limbs& Pow10Tree(size_t level);
+    static Limbs ParseDecimal(std::string_view digits);
+    static std::string FormatDecimal(const Limbs &a);
+    static void FormatDecimalInto(const Limbs &a, std::string &out, size_t width);
+
+    static int CompareBig(const Limbs &a, const Limbs &b);
+    static bool LessThanBig(const Limbs &a, const Limbs &b);
+    static Limbs AddBig(const Limbs &a, const Limbs &b);
+    static Limbs SubBig(const Limbs &a, const Limbs &b);
+    static Limbs MulBig(const Limbs &a, const Limbs &b);
+    static Limbs MulSchoolbook(const Limbs &a, const Limbs &b);
+    static Limbs MulKaratsuba(const Limbs &a, const Limbs &b);
+    static Limbs MulToom3(const Limbs &a, const Limbs &b);
+    static Limbs MulUnbalanced(const Limbs &a, const Limbs &b);
+    static Limbs MulNtt(const Limbs &a, const Limbs &b);
+    template <uint32_t Mod>
+    static void Ntt(std::vector<uint32_t> &a, bool invert);
+    template <uint32_t Mod>
+    static std::vector<uint32_t> ConvolveMod(const std::vector<uint32_t> &a,
+                                             const std::vector<uint32_t> &b, size_t n);
+    static Limbs SliceLimbs(const Limbs &a, size_t from, size_t count);
+    static void AddShifted(Limbs &acc, const Limbs &x, size_t shift);
+    static SignedLimbs AddSigned(const SignedLimbs &a, const SignedLimbs &b);
+    static SignedLimbs SubSigned(const SignedLimbs &a, const SignedLimbs &b);
+    static void MulSmall(Limbs &a, Limb m, Limb add = 0);
+    static Limb DivmodSmall(Limbs &a, Limb d);
+    static void DivmodBig(const Limbs &a, const Limbs &b, Limbs &q, Limbs &r);
+    static void DivmodKnuth(const Limbs &a, const Limbs &b, Limbs &q, Limbs &r);
+    static void DivmodBurnikelZiegler(const Limbs &a, const Limbs &b, Limbs &q, Limbs &r);
+    static void Div2n1n(const Limbs &a, const Limbs &b, size_t n, Limbs &q, Limbs &r);
+    static void Div3n2n(const Limbs &a, const Limbs &b, size_t h, Limbs &q, Limbs &r);
+    static Limbs ShiftLeft(const Limbs &a, size_t bits);
+    static Limbs ShiftRight(const Limbs &a, size_t bits);
+    static Limbs GcdBig(Limbs a, Limbs b);
+    static Limbs LinearCombination(const Limbs &a, int64_t ca, const Limbs &b, int64_t cb);
+    static size_t BitLength(const Limbs &a);
+    static Limbs Isqrt(const Limbs &a);
+    static Limbs AtanhFixed(const Limbs &z, size_t bits);
+    static Limbs Ln2Fixed(size_t bits);
+    static SignedLimbs LnFixed(const Limbs &num, const Limbs &den, size_t bits);
+    static Limbs ExpFixed(const SignedLimbs &t, size_t bits, long long &exponent);
+    void Reduce() const;
+    void ReduceLazily();
+    void Canonicalize() const;
+
+    static ReduceBudget reduce_budget_;
+    static size_t precision_;
+
+    // Mutable so that const observers can cache the canonical form; the
+    // value represented never changes behind the caller's back.
+    mutable Limbs num_;
+    mutable Limbs den_;
+    mutable bool negative_;
+    mutable bool is_small_;
+    mutable long long small_;
+    mutable uint32_t pending_ = 0;
+    mutable size_t reduced_limbs_ = 0;
 };
 
-#endif
\ No newline at end of file
+#endif
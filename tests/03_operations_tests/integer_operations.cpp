@@ -511,7 +511,7 @@ TEST(IntegerOparationsTestSuite, SpecialCases) {
         println(d)
         println(e)
     )";
-    std::string expected = "2\n1\n1\n0.25\n";
+    std::string expected = "2\n2\n-2\n0.25\n";
     std::istringstream input(code);
     std::ostringstream output;
     ASSERT_TRUE(interpret(input, output));
@@ -1302,4 +1302,187 @@ TEST(IntegerOperationsTestSuite, JustBigNumbers2) {
     std::ostringstream output;
     ASSERT_TRUE(interpret(input, output));
     ASSERT_EQ(output.str(), expected);
-}
\ No newline at end of file
+}
+
+TEST(IntegerOperationsTestSuite, LimbBoundaries) {
+    std::string code = R"(
+        a = 4294967295
+        b = 18446744073709551615
+        println(a + 1)
+        println(b + 1)
+        println((b + 1) - 1 == b)
+        println((b + 1) / 4294967296)
+        println(1000000000000000000000 % 4294967296)
+    )";
+    std::string expected = "4294967296\n18446744073709551616\ntrue\n4294967296\n3735027712\n";
+    std::istringstream input(code);
+    std::ostringstream output;
+    ASSERT_TRUE(interpret(input, output));
+    ASSERT_EQ(output.str(), expected);
+}
+
+TEST(IntegerOperationsTestSuite, SignedDivision) {
+    std::string code = R"(
+        println(6 / -2)
+        println(-6 / 2)
+        println(-6 / -2)
+        println(-7 % 2)
+    )";
+    std::string expected = "-3\n-3\n3\n-1\n";
+    std::istringstream input(code);
+    std::ostringstream output;
+    ASSERT_TRUE(interpret(input, output));
+    ASSERT_EQ(output.str(), expected);
+}
+
+TEST(IntegerOperationsTestSuite, Int64OverflowPromotion) {
+    std::string code = R"(
+        max = 9223372036854775807
+        println(max + 1)
+        println(-max - 2)
+        println(3037000500 * 3037000500)
+        println((max + 1) - 1 == max)
+        println((max * 4) / 4 == max)
+    )";
+    std::string expected = "9223372036854775808\n-9223372036854775809\n9223372037000250000\ntrue\ntrue\n";
+    std::istringstream input(code);
+    std::ostringstream output;
+    ASSERT_TRUE(interpret(input, output));
+    ASSERT_EQ(output.str(), expected);
+}
+
+TEST(IntegerOperationsTestSuite, SubquadraticMultiplication) {
+    std::string code = R"(
+        a = 10 ^ 700 + 7
+        b = 10 ^ 700 - 7
+        println(a * b == 10 ^ 1400 - 49)
+        c = 10 ^ 3000 + 7
+        d = 10 ^ 3000 - 7
+        println(c * d == 10 ^ 6000 - 49)
+        println(len(to_string(2 ^ 20000)))
+        println((7 ^ 3000) % 1000000000000)
+    )";
+    std::string expected = "true\ntrue\n6021\n273841800001\n";
+    std::istringstream input(code);
+    std::ostringstream output;
+    ASSERT_TRUE(interpret(input, output));
+    ASSERT_EQ(output.str(), expected);
+}
+
+TEST(IntegerOperationsTestSuite, NttMultiplication) {
+    std::string code = R"(
+        a = 10 ^ 25000 + 3
+        b = 10 ^ 25000 - 3
+        println(a * b == 10 ^ 50000 - 9)
+        c = 3 ^ 40000
+        println(len(to_string(c)))
+        println(to_string(c)[0:12])
+    )";
+    std::string expected = "true\n19085\n708253593171\n";
+    std::istringstream input(code);
+    std::ostringstream output;
+    ASSERT_TRUE(interpret(input, output));
+    ASSERT_EQ(output.str(), expected);
+}
+
+TEST(IntegerOperationsTestSuite, RecursiveDivision) {
+    std::string code = R"(
+        a = 3 ^ 5000
+        b = 7 ^ 2000 + 1
+        println((a * b + 12345) % b)
+        println((a % b) % 1000000000000)
+        println((a * b) / b == a)
+        println((a - a % b) / b * b + a % b == a)
+    )";
+    std::string expected = "12345\n455092440459\ntrue\ntrue\n";
+    std::istringstream input(code);
+    std::ostringstream output;
+    ASSERT_TRUE(interpret(input, output));
+    ASSERT_EQ(output.str(), expected);
+}
+
+TEST(IntegerOperationsTestSuite, RationalReduction) {
+    std::string code = R"(
+        h = 0
+        for k in range(1, 61, 1)
+            h += 1 / k
+        end for
+        println((h * 3230237388259077233637600) % 1000000000000)
+        s = 0
+        for k in range(1, 201, 1)
+            s += 1 / (k * (k + 1))
+        end for
+        println(s * 201 == 200)
+        a = 2 ^ 300 * 3 ^ 100
+        b = 2 ^ 120 * 5 ^ 90
+        println((a / b) * 5 ^ 90 == 2 ^ 180 * 3 ^ 100)
+    )";
+    std::string expected = "150817026911\ntrue\ntrue\n";
+    std::istringstream input(code);
+    std::ostringstream output;
+    ASSERT_TRUE(interpret(input, output));
+    ASSERT_EQ(output.str(), expected);
+}
+
+TEST(IntegerOperationsTestSuite, DeferredReduction) {
+    std::string code = R"(
+        x = 1 / 3 + 1 / 6
+        println(x)
+        println(x == 1 / 2)
+        y = 0
+        for k in range(1, 41, 1)
+            y += 1 / 2 ^ k
+        end for
+        println(y + 1 / 2 ^ 40 == 1)
+        z = 1 / 4 + 3 / 4
+        println(z)
+        println(z == 1)
+        println(2 ^ z)
+        w = 7 / 12
+        for k in range(0, 50, 1)
+            w = w * 3 / 7 + 1 / 3
+        end for
+        println(w)
+    )";
+    std::string expected = "0.5\ntrue\ntrue\n1\ntrue\n2\n0.58(3)\n";
+    std::istringstream input(code);
+    std::ostringstream output;
+    ASSERT_TRUE(interpret(input, output));
+    ASSERT_EQ(output.str(), expected);
+}
+
+TEST(IntegerOperationsTestSuite, HugeDecimalConversion) {
+    std::string code = R"(
+        s = to_string(3 ^ 20000)
+        println(len(s))
+        println(s[9531:9543])
+        println(s[4770:4782])
+        println(parse_num(s) == 3 ^ 20000)
+        t = to_string(10 ^ 6000 + 1)
+        println(len(t))
+        println(parse_num(t) - 10 ^ 6000)
+    )";
+    std::string expected = "9543\n253104400001\n651619513837\ntrue\n6001\n1\n";
+    std::istringstream input(code);
+    std::ostringstream output;
+    ASSERT_TRUE(interpret(input, output));
+    ASSERT_EQ(output.str(), expected);
+}
+
+TEST(IntegerOperationsTestSuite, PeriodicFractions) {
+    std::string code = R"(
+        println(22 / 7)
+        println(-1 / 12)
+        println(1 / (2 ^ 14 * 3))
+        println(1 / (2 ^ 15 * 3))
+        println(1 / 17)
+        println(1 / 2 ^ 20)
+        println(1 / 3 ^ 2000 * 3 ^ 2000)
+    )";
+    std::string expected = "3.(142857)\n-0.08(3)\n0.00002034505208(3)\n0.000010172526041\n"
+                           "0.058823529411764\n0.00000095367431640625\n1\n";
+    std::istringstream input(code);
+    std::ostringstream output;
+    ASSERT_TRUE(interpret(input, output));
+    ASSERT_EQ(output.str(), expected);
+}